@@ -6,6 +6,7 @@
 
 #include <entt/entt.hpp>
 #include "pi/systems/system_graph.hpp"
+#include "pi/systems/dirty_tracker.hpp"
 
 namespace order {
 enum order {
@@ -35,13 +36,8 @@ using third = order_system<order::third>;
 
 class second : public order_system<order::second> {
 public:
-    template<std::output_iterator<entt::id_type> TypeOutput>
-    static TypeOutput dependencies(TypeOutput into_dependencies)
-    {
-        namespace ranges = std::ranges;
-        return ranges::copy(std::array{ entt::type_hash<first>::value() },
-                            into_dependencies).out;
-    }
+    static constexpr pi::depends_on<first> dependencies{};
+
     static second* load(pi::system_graph& systems)
     {
         systems.load<first>();
@@ -52,14 +48,8 @@ public:
 
 class fourth : public order_system<order::fourth> {
 public:
-    template<std::output_iterator<entt::id_type> TypeOutput>
-    static TypeOutput dependencies(TypeOutput into_dependencies)
-    {
-        namespace ranges = std::ranges;
-        return ranges::copy(std::array{ entt::type_hash<second>::value(),
-                                        entt::type_hash<third>::value() },
-                            into_dependencies).out;
-    }
+    static constexpr pi::depends_on<second, third> dependencies{};
+
     static fourth* load(pi::system_graph& systems)
     {
         systems.load<second>();
@@ -75,6 +65,32 @@ int main()
     std::cout << "\n[load]\n";
     systems.load<fourth>();
 
+    std::cout << "\n[changes]\n";
+    {
+        namespace ranges = std::ranges;
+        constexpr std::array ids{
+            entt::type_hash<first>::value(), entt::type_hash<second>::value(),
+            entt::type_hash<third>::value(), entt::type_hash<fourth>::value()
+        };
+
+        pi::dirty_tracker tracker{ systems };
+        const auto run = [&](entt::id_type id) {
+            const auto index = ranges::find(ids, id) - ids.begin();
+            std::cout << "run " << name_for[index] << "\n";
+            tracker.mark_changed(id);
+        };
+
+        // passes without changes run nothing, but still count as skips
+        tracker.run_pass(run);
+        tracker.run_pass(run);
+
+        // only the systems downstream of first should run
+        tracker.mark_changed<first>();
+        tracker.run_pass(run);
+        std::cout << "skipped " << name_for[order::third] << " "
+                  << tracker.counters_of<third>().skips << " time(s)\n";
+    }
+
     // std::cout << "\n[dependencies]\n";
     // systems.print_dependencies_to(std::cout);
 
@@ -10,6 +10,7 @@
 #include <cmath>
 
 #include <SDL2/SDL_render.h>
+#include "pi/systems/draw_buffer.hpp"
 
 /** Truncate-lerp between two integers */
 template<std::integral Integer, std::floating_point Real>
@@ -104,6 +105,26 @@ struct fibonacci_spiral {
                             | views::transform(sequence(render_frame)),
                          std::bind_front(&draw_rect, renderer));
     }
+    /** Submit the fibonacci spiral to a draw buffer
+     *
+     * The subframes overlap, so they're submitted as geometry to keep their
+     * order while still being drawn in a single call
+     *
+     * \param size the output size of the renderer the buffer is flushed to
+     */
+    inline void draw_rects_to(pi::draw_buffer& draws, SDL_Point size) const
+    {
+        namespace ranges = std::ranges;
+        namespace views = std::views;
+
+        // the pattern will be draw to the entire screen
+        SDL_Rect render_frame{ 0, 0, size.x, size.y };
+        ranges::for_each(views::iota(0u, num_frames)
+                            | views::transform(sequence(render_frame)),
+                         [&draws](const colored_rect& frame) {
+                             draws.fill_quad(frame.first, frame.second);
+                         });
+    }
     SDL_Color initial_color, final_color;
     std::uint32_t num_frames;
 };
@@ -0,0 +1,184 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <functional>
+
+#include <array>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <cstddef>
+
+#include <SDL2/SDL_render.h>
+
+inline namespace pi {
+
+/** A per-frame buffer of draw commands, flushed to a renderer in batches
+ *
+ * Commands are grouped by layer, and layers are drawn in ascending order.
+ * Within a layer, filled rects are sorted by color so that each run of a
+ * single color is drawn with one call, then all of the layer's geometry is
+ * drawn with one call in the order it was submitted. Draws that must
+ * overlap in a particular order should either be submitted as geometry or
+ * placed on separate layers.
+ *
+ * Flushing clears the buffer but keeps its memory, so a buffer that's
+ * reused every frame stops allocating once it has grown to fit a frame.
+ */
+class draw_buffer {
+public:
+    /** Queue a filled rect */
+    void fill_rect(const SDL_Rect& rect, const SDL_Color& color, int layer = 0)
+    {
+        rects.push_back(rect_command{ layer, color, rect });
+    }
+
+    /** Queue a filled rect as geometry, keeping its submission order */
+    void fill_quad(const SDL_Rect& rect, const SDL_Color& color, int layer = 0)
+    {
+        const auto left = static_cast<float>(rect.x);
+        const auto top = static_cast<float>(rect.y);
+        const auto right = static_cast<float>(rect.x + rect.w);
+        const auto bottom = static_cast<float>(rect.y + rect.h);
+
+        const std::array<SDL_Vertex, 4> corners{
+            SDL_Vertex{ SDL_FPoint{ left, top }, color, SDL_FPoint{} },
+            SDL_Vertex{ SDL_FPoint{ right, top }, color, SDL_FPoint{} },
+            SDL_Vertex{ SDL_FPoint{ right, bottom }, color, SDL_FPoint{} },
+            SDL_Vertex{ SDL_FPoint{ left, bottom }, color, SDL_FPoint{} }
+        };
+        constexpr std::array triangles{ 0, 1, 2, 0, 2, 3 };
+        fill_geometry(corners, triangles, layer);
+    }
+
+    /** Queue untextured triangles
+     *
+     * \param vertices the colored vertices of the triangles
+     * \param triangle_indices indices into vertices, three per triangle
+     * \param layer the layer to draw the triangles on
+     */
+    void fill_geometry(std::span<const SDL_Vertex> vertices,
+                       std::span<const int> triangle_indices, int layer = 0)
+    {
+        namespace ranges = std::ranges;
+
+        const auto offset = static_cast<int>(geometry_vertices.size());
+        geometry.push_back(geometry_command{
+            layer, geometry_indices.size(), triangle_indices.size() });
+
+        ranges::copy(vertices, std::back_inserter(geometry_vertices));
+        ranges::transform(triangle_indices,
+                          std::back_inserter(geometry_indices),
+                          std::bind_front(std::plus<int>{}, offset));
+    }
+
+    /** The number of queued commands */
+    std::size_t size() const { return rects.size() + geometry.size(); }
+    bool empty() const { return rects.empty() and geometry.empty(); }
+
+    /** Discard every queued command, keeping the buffer's memory */
+    void clear()
+    {
+        rects.clear(); geometry.clear();
+        geometry_vertices.clear(); geometry_indices.clear();
+    }
+
+    /** Draw every queued command to a renderer, then clear the buffer */
+    void flush_to(SDL_Renderer* renderer)
+    {
+        namespace ranges = std::ranges;
+
+        ranges::sort(rects, std::less{}, &rect_command::key);
+        ranges::stable_sort(geometry, std::less{}, &geometry_command::layer);
+
+        auto next_rect = rects.begin();
+        auto next_geometry = geometry.begin();
+        while (next_rect != rects.end() or next_geometry != geometry.end()) {
+
+            // draw the lowest layer that has any commands left
+            int layer = next_rect != rects.end()? next_rect->layer
+                                                : next_geometry->layer;
+            if (next_geometry != geometry.end()) {
+                layer = std::min(layer, next_geometry->layer);
+            }
+            next_rect = flush_rects(renderer, next_rect, layer);
+            next_geometry = flush_geometry(renderer, next_geometry, layer);
+        }
+        clear();
+    }
+private:
+    struct rect_command {
+        int layer;
+        SDL_Color color;
+        SDL_Rect rect;
+
+        using state = std::tuple<int, Uint8, Uint8, Uint8, Uint8>;
+        state key() const
+        {
+            return state{ layer, color.r, color.g, color.b, color.a };
+        }
+    };
+    struct geometry_command {
+        int layer;
+        std::size_t first_index, num_indices;
+    };
+    using rect_iterator = std::vector<rect_command>::iterator;
+    using geometry_iterator = std::vector<geometry_command>::iterator;
+
+    // draw each run of same-colored rects in a layer with a single call
+    rect_iterator flush_rects(SDL_Renderer* renderer,
+                              rect_iterator first, int layer)
+    {
+        namespace ranges = std::ranges;
+        while (first != rects.end() and first->layer == layer) {
+            const auto state = first->key();
+            const auto last = std::find_if(first, rects.end(),
+                [&state](const rect_command& command) {
+                    return command.key() != state;
+                });
+
+            batch_rects.clear();
+            ranges::transform(first, last, std::back_inserter(batch_rects),
+                              &rect_command::rect);
+
+            const auto& color = first->color;
+            SDL_SetRenderDrawColor(renderer, color.r, color.g,
+                                             color.b, color.a);
+            SDL_RenderFillRects(renderer, batch_rects.data(),
+                                static_cast<int>(batch_rects.size()));
+            first = last;
+        }
+        return first;
+    }
+
+    // draw all of the geometry in a layer with a single call
+    geometry_iterator flush_geometry(SDL_Renderer* renderer,
+                                     geometry_iterator first, int layer)
+    {
+        batch_indices.clear();
+        for (; first != geometry.end() and first->layer == layer; ++first) {
+            const auto begin = geometry_indices.begin() + first->first_index;
+            batch_indices.insert(batch_indices.end(),
+                                 begin, begin + first->num_indices);
+        }
+        if (not batch_indices.empty()) {
+            SDL_RenderGeometry(renderer, nullptr,
+                               geometry_vertices.data(),
+                               static_cast<int>(geometry_vertices.size()),
+                               batch_indices.data(),
+                               static_cast<int>(batch_indices.size()));
+        }
+        return first;
+    }
+
+    std::vector<rect_command> rects;
+    std::vector<geometry_command> geometry;
+    std::vector<SDL_Vertex> geometry_vertices;
+    std::vector<int> geometry_indices;
+
+    // scratch space reused between flushes
+    std::vector<SDL_Rect> batch_rects;
+    std::vector<int> batch_indices;
+};
+}
@@ -15,12 +15,14 @@ public:
     init_system& operator=(const init_system&) = delete;
 
     inline init_system(init_system && tmp)
-        : should_quit{ std::exchange(tmp.should_quit, false) }
+        : should_quit{ std::exchange(tmp.should_quit, false) },
+          headless{ tmp.headless }
     {
     }
     inline init_system& operator=(init_system && tmp)
     {
         should_quit = std::exchange(tmp.should_quit, false);
+        headless = tmp.headless;
         return *this;
     }
     inline ~init_system()
@@ -32,19 +34,34 @@ public:
     }
 #pragma endregion
 
-    inline static init_system* load(system_graph& systems)
+    /** Initialize SDL
+     *
+     * \param headless use SDL's dummy video driver, so that windows and
+     *                 software renderers can be created without a display
+     */
+    inline static init_system* load(system_graph& systems,
+                                    bool headless = false)
     {
         // config parameters
         constexpr auto flags = SDL_INIT_VIDEO;
+        constexpr std::string_view headless_driver = "dummy";
 
+        if (headless) {
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, headless_driver.data());
+        }
         if (SDL_Init(flags) != 0) {
             std::printf("Failed to initialize SDL: %s\n", SDL_GetError());
             return nullptr;
         }
-        return &systems.emplace<init_system>(init_system{});
+        return &systems.emplace<init_system>(init_system{ headless });
     }
+    /** Determine if SDL was initialized without a display */
+    bool is_headless() const { return headless; }
 private:
     init_system() = default;
+    explicit init_system(bool headless) : headless{ headless } {}
+
     bool should_quit = true;
+    bool headless = false;
 };
 }
@@ -0,0 +1,157 @@
+#pragma once
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <algorithm>
+
+#include <array>
+#include <chrono>
+
+#include <cmath>
+#include <cstdint>
+
+#include <SDL2/SDL_events.h>
+#include <entt/core/fwd.hpp>
+
+#include "pi/systems/system_graph.hpp"
+#include "pi/systems/init_system.hpp"
+
+inline namespace pi {
+
+/** A callback that handles an event, returning true if it changed anything */
+template<typename Handler>
+concept event_handler = std::invocable<Handler, const SDL_Event&> and
+    std::convertible_to<std::invoke_result_t<Handler, const SDL_Event&>, bool>;
+
+/** A fixed-step update, returning true while it still has work to do */
+template<typename Update>
+concept step_update = std::invocable<Update, double> and
+    std::convertible_to<std::invoke_result_t<Update, double>, bool>;
+
+/** System that paces the main loop
+ *
+ * Updates run with a fixed timestep, while rendering happens at most once per
+ * frame at the target frame rate. When nothing is dirty and no update is in
+ * progress, the loop sleeps in SDL_WaitEventTimeout instead of spinning, and
+ * wakes as soon as an event arrives.
+ */
+class loop_system {
+public:
+    using clock = std::chrono::steady_clock;
+    using seconds = std::chrono::duration<double>;
+
+    static constexpr depends_on<init_system> dependencies{};
+
+    /** Load a main loop
+     *
+     * \param frame_rate the maximum number of frames to render per second
+     * \param update_rate the number of fixed-step updates per second
+     */
+    inline static loop_system* load(system_graph& systems,
+                                    std::uint32_t frame_rate = 60u,
+                                    std::uint32_t update_rate = 60u)
+    {
+        if (not systems.load<init_system>()) { return nullptr; }
+        return &systems.emplace<loop_system>(
+                seconds{ 1.0/std::max(frame_rate, 1u) },
+                seconds{ 1.0/std::max(update_rate, 1u) });
+    }
+    inline loop_system(seconds frame_period, seconds update_step)
+        : frame_period{
+              std::chrono::duration_cast<clock::duration>(frame_period) },
+          update_step{ update_step }
+    {
+    }
+
+    /** Request that the next frame be rendered */
+    void mark_dirty() { dirty = true; }
+
+    /** Start running fixed-step updates again */
+    void resume_updates() { updating = true; }
+
+    /** Stop the loop after the current frame */
+    void quit() { running = false; }
+
+    /** Run the loop until quit, or until the application is asked to quit
+     *
+     * \param on_event called for every event, marks the frame dirty if true
+     * \param update   called with the timestep for every fixed step that has
+     *                 elapsed. Updates keep running while it returns true
+     * \param render   called with how far, from 0 to 1, the frame is between
+     *                 the last update and the next
+     */
+    template<event_handler OnEvent, step_update Update,
+             std::invocable<double> Render>
+    void run(OnEvent on_event, Update update, Render render)
+    {
+        running = true;
+        auto last_update = clock::now();
+        auto next_frame = last_update;
+        seconds lag{ 0.0 };
+
+        while (running) {
+            // sleep until the next frame is due, or for as long as possible
+            // if there's nothing to draw, waking early for any input
+            const bool was_updating = updating;
+            const bool has_work = dirty or updating;
+            handle_events(on_event, has_work? next_frame - clock::now()
+                                            : idle_timeout);
+            if (not running) { break; }
+
+            // idle time doesn't need to be simulated, so updates that were
+            // resumed while waiting start counting from now
+            const auto now = clock::now();
+            if (updating and was_updating) { lag += now - last_update; }
+            last_update = now;
+
+            // catch up on fixed steps, dropping time that's too far behind
+            lag = std::min(lag, max_lag);
+            while (updating and lag >= update_step) {
+                updating = std::invoke(update, update_step.count());
+                lag = updating? lag - update_step : seconds{ 0.0 };
+                dirty = true;
+            }
+
+            // only render once per frame period
+            if ((dirty or updating) and now >= next_frame) {
+                std::invoke(render, lag/update_step);
+                dirty = false;
+                next_frame = std::max(next_frame, now) + frame_period;
+            }
+        }
+    }
+private:
+    static constexpr seconds idle_timeout{ 0.5 };
+    static constexpr seconds max_lag{ 0.25 };
+
+    template<event_handler OnEvent>
+    void handle_events(OnEvent& on_event, seconds timeout)
+    {
+        namespace chrono = std::chrono;
+        using milliseconds = chrono::duration<double, std::milli>;
+
+        const auto wait_ms = static_cast<int>(std::ceil(
+                std::max(milliseconds{ timeout }, milliseconds{ 0.0 })
+                    .count()));
+
+        // block for the first event, then drain the rest without waiting
+        SDL_Event event;
+        int has_event = wait_ms > 0? SDL_WaitEventTimeout(&event, wait_ms)
+                                   : SDL_PollEvent(&event);
+        while (has_event) {
+            if (event.type == SDL_QUIT) { running = false; }
+            if (std::invoke(on_event, static_cast<const SDL_Event&>(event))) {
+                dirty = true;
+            }
+            has_event = SDL_PollEvent(&event);
+        }
+    }
+
+    clock::duration frame_period;
+    seconds update_step;
+
+    bool running = false;
+    bool dirty = true;
+    bool updating = true;
+};
+}
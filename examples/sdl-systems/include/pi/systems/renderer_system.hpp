@@ -12,40 +12,61 @@
 #include <entt/core/fwd.hpp>
 
 #include "pi/systems/system_graph.hpp"
+#include "pi/systems/init_system.hpp"
 #include "pi/systems/window_system.hpp"
 #include "pi/systems/sdl_deleter.hpp"
+#include "pi/systems/draw_buffer.hpp"
 
 inline namespace pi {
 class renderer_system {
 public:
     using unique_renderer = std::unique_ptr<SDL_Renderer, sdl_deleter>;
 
-    template<std::output_iterator<entt::id_type> TypeOutput>
-    inline static TypeOutput dependencies(TypeOutput into_types)
-    {
-        namespace ranges = std::ranges;
-        return ranges::copy(
-                std::array{ entt::type_hash<window_system>::value() },
-                into_types).out;
-    }
+    static constexpr depends_on<window_system> dependencies{};
+
     inline static renderer_system* load(pi::system_graph& systems)
     {
         auto* window_sys = systems.load<window_system>();
         if (not window_sys) { return nullptr; }
 
         // config parameters
-        constexpr auto flags = SDL_RENDERER_ACCELERATED;
+        // there's no display to accelerate when headless, so render to the
+        // window's surface in software instead
+        const auto* init_sys = systems.find<init_system>();
+        const auto flags = init_sys and init_sys->is_headless()
+                         ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED;
+        constexpr int first_supporting_driver = -1;
 
         auto* window = window_sys->window();
-        auto* renderer = SDL_CreateRenderer(window, flags, -1);
-
+        auto* renderer = SDL_CreateRenderer(window, first_supporting_driver,
+                                            flags);
         if (not renderer) {
             std::printf("Failed to create a renderer: %s\n", SDL_GetError());
+            return nullptr;
         }
         return &systems.emplace<renderer_system>(unique_renderer{ renderer });
     }
     SDL_Renderer* renderer() { return renderer_handle.get(); }
 
+    /** Get the size of the renderer's output in pixels */
+    SDL_Point output_size()
+    {
+        SDL_Point size{ 0, 0 };
+        SDL_GetRendererOutputSize(renderer(), &size.x, &size.y);
+        return size;
+    }
+
+    /** Get the buffer that draw commands for this frame are submitted to */
+    draw_buffer& draws() { return frame_draws; }
+
+    /** Draw every submitted command, then present the frame */
+    void present()
+    {
+        frame_draws.flush_to(renderer());
+        SDL_RenderPresent(renderer());
+    }
+
     unique_renderer renderer_handle;
+    draw_buffer frame_draws;
 };
 }
@@ -21,15 +21,14 @@ class window_system {
 public:
     using unique_window = std::unique_ptr<SDL_Window, sdl_deleter>;
 
-    template<std::output_iterator<entt::id_type> TypeOutput>
-    inline static TypeOutput dependencies(TypeOutput into_dependencies)
-    {
-        namespace ranges = std::ranges;
-        return ranges::copy(
-                std::array{ entt::type_hash<init_system>::value() },
-                into_dependencies).out;
-    }
-    inline static window_system* load(system_graph& systems)
+    static constexpr depends_on<init_system> dependencies{};
+
+    /** Create a window
+     *
+     * \param size the width and height of the window
+     */
+    inline static window_system* load(system_graph& systems,
+                                      SDL_Point size = { 640, 480 })
     {
         if (not systems.load<init_system>()) { return nullptr; }
 
@@ -38,7 +37,6 @@ public:
         constexpr SDL_Point position{
             SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED
         };
-        constexpr SDL_Point size{ 640, 480 };
         constexpr auto flags = 0u;
 
         auto* window = SDL_CreateWindow(name.data(),
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <concepts>
+#include <charconv>
+#include <system_error>
+#include <chrono>
+#include <functional>
+
+#include <string_view>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <SDL2/SDL_render.h>
+
+#include "pi/systems/system_graph.hpp"
+#include "pi/systems/init_system.hpp"
+#include "pi/systems/window_system.hpp"
+#include "pi/systems/renderer_system.hpp"
+#include "fibonacci_spiral.hpp"
+
+using frame_clock = std::chrono::steady_clock;
+using microseconds = std::chrono::duration<double, std::micro>;
+
+/** Parse a positive integer argument, or keep the default if there isn't one
+ *
+ * \return false if the argument isn't a positive integer
+ */
+template<std::integral Integer>
+bool parse_arg(int argc, char** argv, int index, Integer& value)
+{
+    if (index >= argc) { return true; }
+
+    const std::string_view arg = argv[index];
+    Integer parsed{};
+    const auto [end, error] = std::from_chars(arg.data(),
+                                              arg.data() + arg.size(), parsed);
+    if (error != std::errc{} or end != arg.data() + arg.size() or parsed <= 0) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+/** Render a number of frames and report their p50 and p99 frame times */
+template<std::invocable Draw>
+void time_frames(std::string_view name, SDL_Renderer* renderer,
+                 std::uint32_t num_frames, Draw draw)
+{
+    std::vector<microseconds> frame_times;
+    frame_times.reserve(num_frames);
+
+    for (std::uint32_t frame = 0u; frame < num_frames; ++frame) {
+        const auto start = frame_clock::now();
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        std::invoke(draw);
+
+        frame_times.push_back(frame_clock::now() - start);
+    }
+
+    // nearest-rank percentiles
+    namespace ranges = std::ranges;
+    ranges::sort(frame_times);
+    const auto percentile = [&frame_times](std::size_t p) {
+        const auto rank = (p*frame_times.size() + 99u)/100u;
+        return frame_times[std::max<std::size_t>(rank, 1u) - 1u].count();
+    };
+    std::printf("%-10s p50 %10.2f us   p99 %10.2f us\n",
+                name.data(), percentile(50u), percentile(99u));
+}
+
+/** Submit the spiral as filled rects, one layer per subframe
+ *
+ * Layers keep the overlapping subframes in order, at the cost of a separate
+ * fill call per subframe
+ */
+void fill_rects_to(const fibonacci_spiral& spiral, pi::draw_buffer& draws,
+                   SDL_Point size)
+{
+    SDL_Rect render_frame{ 0, 0, size.x, size.y };
+    const auto next_subframe = spiral.sequence(render_frame);
+    for (std::uint32_t k = 0u; k < spiral.num_frames; ++k) {
+        const auto [rect, color] = next_subframe(k);
+        draws.fill_rect(rect, color, static_cast<int>(k));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // benchmark parameters
+    SDL_Point size{ 640, 480 };
+    std::uint32_t num_frames = 1000u;
+    std::uint32_t num_subframes = 9u;
+
+    if (not parse_arg(argc, argv, 1, size.x) or
+        not parse_arg(argc, argv, 2, size.y) or
+        not parse_arg(argc, argv, 3, num_frames) or
+        not parse_arg(argc, argv, 4, num_subframes)) {
+
+        std::printf("usage: %s [width height [frames [subframes]]]\n",
+                    argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pi::system_graph systems;
+    constexpr bool headless = true;
+    if (not systems.load<pi::init_system>(headless) or
+        not systems.load<pi::window_system>(size)) {
+
+        std::printf("Fatal error: unable to load headless systems\n");
+        return EXIT_FAILURE;
+    }
+    auto* renderer_system = systems.load<pi::renderer_system>();
+    if (not renderer_system) {
+        std::printf("Fatal error: unable to load fundamental systems\n");
+        return EXIT_FAILURE;
+    }
+    SDL_Renderer* renderer = renderer_system->renderer();
+
+    // design parameters
+    constexpr SDL_Color blue{ 48, 118, 217, 255 };
+    constexpr SDL_Color red{ 219, 0, 66, 255 };
+    const fibonacci_spiral spiral(blue, red, num_subframes);
+
+    std::printf("%dx%d, %u frames of %u subframes\n",
+                size.x, size.y, num_frames, num_subframes);
+
+    time_frames("immediate", renderer, num_frames, [&] {
+        spiral.draw_rects_to(renderer);
+        SDL_RenderPresent(renderer);
+    });
+    time_frames("batched", renderer, num_frames, [&] {
+        spiral.draw_rects_to(renderer_system->draws(),
+                             renderer_system->output_size());
+        renderer_system->present();
+    });
+    time_frames("layered", renderer, num_frames, [&] {
+        fill_rects_to(spiral, renderer_system->draws(),
+                      renderer_system->output_size());
+        renderer_system->present();
+    });
+    return EXIT_SUCCESS;
+}
@@ -5,38 +5,34 @@
 
 #include "pi/systems/system_graph.hpp"
 #include "pi/systems/renderer_system.hpp"
+#include "pi/systems/loop_system.hpp"
 #include "fibonacci_spiral.hpp"
 
 int main()
 {
     pi::system_graph systems;
     auto* renderer_system = systems.load<pi::renderer_system>();
+    auto* loop_system = systems.load<pi::loop_system>();
 
-    if (not renderer_system) {
+    if (not renderer_system or not loop_system) {
         std::printf("Fatal error: unable to load fundamental systems\n");
         return EXIT_FAILURE;
     }
-    SDL_Renderer* renderer = renderer_system->renderer();
 
     // design parameters
     constexpr SDL_Color blue{ 48, 118, 217, 255 };
     constexpr SDL_Color red{ 219, 0, 66, 255 };
     constexpr std::uint32_t num_frames = 9u;
-
-    fibonacci_spiral(blue, red, num_frames)
-        .draw_rects_to(renderer);
-
-    SDL_RenderPresent(renderer);
-
-    bool has_quit = false;
-    while (not has_quit) {
-
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                has_quit = true;
-            }
-        }
-    }
+    const fibonacci_spiral spiral(blue, red, num_frames);
+
+    // the spiral never changes, so only redraw when the window needs it
+    loop_system->run(
+        [](const SDL_Event& event) { return event.type == SDL_WINDOWEVENT; },
+        [](double) { return false; },
+        [&](double) {
+            spiral.draw_rects_to(renderer_system->draws(),
+                                 renderer_system->output_size());
+            renderer_system->present();
+        });
     return EXIT_SUCCESS;
 }
@@ -3,12 +3,18 @@
 #include <algorithm>
 #include <ranges>
 
+#include <iterator>
+
 #include <unordered_set>
 #include <unordered_map>
+#include <optional>
+#include <memory>
 #include <utility>
 #include <vector>
 #include <deque>
 
+#include <cstddef>
+
 inline namespace pi {
 #ifndef hashable
 template<typename T>
@@ -183,98 +189,128 @@ void bfs_cut(const directed_adjacency_map<Vertex>& g, Vertex root,
     }
 }
 
-namespace internal {
-
-template<hashable Vertex>
-auto is_root_of(const directed_adjacency_map<Vertex>& g)
-{
-    return [&g](const directed_adjacency_map<Vertex>::value_type& elem) {
-        return elem.second.incoming.empty();
-    };
-}
-template<hashable Vertex>
-auto is_leaf_of(const directed_adjacency_map<Vertex>& g)
-{
-    return [&g](const directed_adjacency_map<Vertex>::value_type& elem) {
-        return elem.second.outgoing.empty();
-    };
-}
-
+/** A lazy view of a graph's vertices in topological order
+ *
+ * Vertices are found with Kahn's algorithm as the view is iterated, so only
+ * as much of the graph is traversed as is consumed. In the forward direction
+ * every vertex comes after all of its incoming vertices, and in the reverse
+ * direction after all of its outgoing vertices. Vertices that are part of a
+ * cycle are never reached.
+ *
+ * The view is single-pass, and copies of it share their progress: calling
+ * begin again resumes where the last iterator left off, so a view can be
+ * consumed in chunks, e.g. with views::take. The graph must outlive the view.
+ */
 template<direction Direction, hashable Vertex>
-auto cut_if_unvisited(const directed_adjacency_map<Vertex>& g,
-                      const vertex_set<Vertex>& visited)
+class topological_view
+    : public std::ranges::view_interface<topological_view<Direction, Vertex>>
 {
-    namespace ranges = std::ranges;
-    using namespace internal;
-
-    return [&](const auto vertex) {
-        const auto search = g.find(vertex);
-        if (g.end() == search) { return false; }
+    class traversal;
+public:
+    class iterator {
+    public:
+        using value_type = Vertex;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(traversal* state) : state{ state } {}
+
+        Vertex operator*() const { return *state->current; }
+        iterator& operator++() { state->advance(); return *this; }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t)
+        {
+            // a default constructed view is empty
+            return not it.state or not it.state->current.has_value();
+        }
+    private:
+        traversal* state = nullptr;
+    };
 
-        const auto& incoming = parents_of<Direction>(search->second);
-        return not ranges::includes(visited, incoming);
+    topological_view() = default;
+    explicit topological_view(const directed_adjacency_map<Vertex>& g)
+        : state{ std::make_shared<traversal>(g) }
+    {
+    }
+    iterator begin()
+    {
+        // without a graph there's nothing to traverse: begin is also end
+        if (not state) { return iterator{}; }
+        return iterator{ state.get() };
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+private:
+    class traversal {
+    public:
+        explicit traversal(const directed_adjacency_map<Vertex>& g)
+            : graph{ &g }, scan{ g.begin() }
+        {
+            advance();
+        }
+        void advance()
+        {
+            using namespace internal;
+
+            // a child is ready once its last parent has been visited
+            if (current) {
+                const auto& edges = graph->find(*current)->second;
+                for (const Vertex child : children_of<Direction>(edges)) {
+                    const auto search = graph->find(child);
+                    if (graph->end() == search) { continue; }
+
+                    const auto& parents = parents_of<Direction>(search->second);
+                    auto [unvisited, _] =
+                        unvisited_parents.try_emplace(child, parents.size());
+                    if (--unvisited->second == 0u) { ready.push_back(child); }
+                }
+            }
+            // only look for another root when nothing else is ready
+            for (; ready.empty() and graph->end() != scan; ++scan) {
+                if (parents_of<Direction>(scan->second).empty()) {
+                    ready.push_back(scan->first);
+                }
+            }
+            current.reset();
+            if (not ready.empty()) {
+                current = ready.front();
+                ready.pop_front();
+            }
+        }
+        std::optional<Vertex> current;
+    private:
+        const directed_adjacency_map<Vertex>* graph;
+        typename directed_adjacency_map<Vertex>::const_iterator scan;
+        std::deque<Vertex> ready;
+        std::unordered_map<Vertex, std::size_t> unvisited_parents;
     };
-}
+    std::shared_ptr<traversal> state;
+};
 
+/** Lazily view the vertices of a graph in topological order */
 template<hashable Vertex>
-auto cut_if_unvisited_parents(const directed_adjacency_map<Vertex>& g,
-                              const vertex_set<Vertex>& visited)
-{
-    return cut_if_unvisited<direction::forward>(g, visited);
-}
-template<hashable Vertex>
-auto cut_if_unvisited_children(const directed_adjacency_map<Vertex>& g,
-                               const vertex_set<Vertex>& visited)
+auto topological_order(const directed_adjacency_map<Vertex>& g)
 {
-    return cut_if_unvisited<direction::reverse>(g, visited);
+    return topological_view<direction::forward, Vertex>{ g };
 }
 
-template<hashable Vertex, std::invocable<Vertex> Visitor>
-auto visit_with_set(Visitor visit, vertex_set<Vertex>& visited)
+/** Lazily view the vertices of a graph in reverse topological order */
+template<hashable Vertex>
+auto reverse_topological_order(const directed_adjacency_map<Vertex>& g)
 {
-    return [&visited, visit](Vertex vertex) {
-        std::invoke(visit, vertex);
-        visited.emplace(vertex);
-    };
-}
+    return topological_view<direction::reverse, Vertex>{ g };
 }
 
 template<hashable Vertex, std::invocable<Vertex> Visitor>
 void for_each(const directed_adjacency_map<Vertex>& g, Visitor visit)
 {
-    namespace ranges = std::ranges; namespace views = std::views;
-    using namespace internal;
-
-    std::vector<Vertex> roots;
-    ranges::transform(g | views::filter(is_root_of(g)),
-                      std::back_inserter(roots),
-                      &directed_adjacency_map<Vertex>::value_type::first);
-
-    vertex_set<Vertex> visited;
-    constexpr auto forward = direction::forward;
-    for (const auto root : roots) {
-        bfs_cut<forward>(g, root, visit_with_set(visit, visited),
-                                  cut_if_unvisited_parents(g, visited));
-    };
+    std::ranges::for_each(topological_order(g), visit);
 }
 
 template<hashable Vertex, std::invocable<Vertex> Visitor>
 void rfor_each(const directed_adjacency_map<Vertex>& g, Visitor visit)
 {
-    namespace ranges = std::ranges; namespace views = std::views;
-    using namespace internal;
-    using adjacency_mapping = directed_adjacency_map<Vertex>::value_type;
-
-    std::vector<Vertex> leafs;
-    ranges::transform(g | views::filter(is_leaf_of(g)),
-                      std::back_inserter(leafs), &adjacency_mapping::first);
-
-    vertex_set<Vertex> visited;
-    constexpr auto reverse = direction::reverse;
-    for (const auto leaf : leafs) {
-        bfs_cut<reverse>(g, leaf, visit_with_set(visit, visited),
-                                  cut_if_unvisited_children(g, visited));
-    };
+    std::ranges::for_each(reverse_topological_order(g), visit);
 }
 }
 }
@@ -0,0 +1,266 @@
+#pragma once
+#include <concepts>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+#include <utility>
+#include <bit>
+
+#include <cstddef>
+#include <cstdint>
+
+inline namespace pi {
+
+namespace internal {
+// head and tail are written by different threads, so they're kept on
+// separate cache lines to avoid false sharing between producer and consumer
+inline constexpr std::size_t cache_line_size = 64;
+}
+
+template<typename Channel>
+concept message_channel = requires {
+    typename Channel::message_type;
+    { Channel::single_producer } -> std::convertible_to<bool>;
+};
+
+/** A bounded, lock-free single-producer single-consumer message channel
+ *
+ * All message slots are allocated up front, so sending and receiving
+ * messages never allocates
+ */
+template<typename Message>
+requires std::default_initializable<Message> and std::movable<Message>
+class spsc_channel {
+public:
+    using message_type = Message;
+    static constexpr bool single_producer = true;
+
+#pragma region Rule of Five
+    spsc_channel(const spsc_channel&) = delete;
+    spsc_channel& operator=(const spsc_channel&) = delete;
+    spsc_channel(spsc_channel &&) = delete;
+    spsc_channel& operator=(spsc_channel &&) = delete;
+    ~spsc_channel() = default;
+#pragma endregion
+
+    /** Create a channel that holds at least capacity messages */
+    explicit spsc_channel(std::size_t capacity)
+        : mask{ std::bit_ceil(std::max<std::size_t>(capacity, 1u)) - 1u },
+          slots{ std::make_unique<Message[]>(mask + 1u) }
+    {
+    }
+
+    /** The maximum number of messages the channel can hold at once */
+    std::size_t capacity() const { return mask + 1u; }
+
+    /** The number of messages waiting to be received */
+    std::size_t size() const
+    {
+        // read head first so it can't have moved past the tail we read
+        const auto pos = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - pos;
+    }
+    bool empty() const { return size() == 0u; }
+
+    /** Construct a message in the next free slot
+     *
+     * \return false if the channel is full, in which case nothing is sent
+     *
+     * Only the producer may call this
+     */
+    template<typename... Args>
+    requires std::constructible_from<Message, Args...>
+    bool try_emplace(Args &&... args)
+    {
+        const auto pos = tail.load(std::memory_order_relaxed);
+        if (pos - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (pos - cached_head > mask) { return false; }
+        }
+        slots[pos & mask] = Message(std::forward<Args>(args)...);
+        tail.store(pos + 1u, std::memory_order_release);
+        return true;
+    }
+    bool try_send(const Message& message) { return try_emplace(message); }
+    bool try_send(Message && message)
+    {
+        return try_emplace(std::move(message));
+    }
+
+    /** Move the oldest message out of the channel
+     *
+     * \param message assigned the received message
+     * \return false if the channel is empty
+     *
+     * Only the consumer may call this
+     */
+    bool try_receive(Message& message)
+    {
+        const auto pos = head.load(std::memory_order_relaxed);
+        if (pos == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (pos == cached_tail) { return false; }
+        }
+        message = std::move(slots[pos & mask]);
+        head.store(pos + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /** Visit every waiting message in order, consuming them
+     *
+     * \return the number of messages visited
+     *
+     * Messages are visited in place and released in a single step, so a
+     * burst of messages only synchronizes with the producer once
+     */
+    template<std::invocable<Message&> Visitor>
+    std::size_t drain(Visitor visit)
+    {
+        const auto first = head.load(std::memory_order_relaxed);
+        cached_tail = tail.load(std::memory_order_acquire);
+
+        for (auto pos = first; pos != cached_tail; ++pos) {
+            std::invoke(visit, slots[pos & mask]);
+        }
+        head.store(cached_tail, std::memory_order_release);
+        return cached_tail - first;
+    }
+private:
+    const std::size_t mask;
+    const std::unique_ptr<Message[]> slots;
+
+    // written by the consumer, cached by the producer
+    alignas(internal::cache_line_size) std::atomic<std::size_t> head{ 0u };
+    alignas(internal::cache_line_size) std::size_t cached_tail = 0u;
+
+    // written by the producer, cached by the consumer
+    alignas(internal::cache_line_size) std::atomic<std::size_t> tail{ 0u };
+    alignas(internal::cache_line_size) std::size_t cached_head = 0u;
+};
+
+/** A bounded, lock-free multi-producer single-consumer message channel
+ *
+ * Each slot carries a sequence number that producers claim slots with, so
+ * any number of producers can send without locking. All message slots are
+ * allocated up front, so sending and receiving messages never allocates
+ */
+template<typename Message>
+requires std::default_initializable<Message> and std::movable<Message>
+class mpsc_channel {
+public:
+    using message_type = Message;
+    static constexpr bool single_producer = false;
+
+#pragma region Rule of Five
+    mpsc_channel(const mpsc_channel&) = delete;
+    mpsc_channel& operator=(const mpsc_channel&) = delete;
+    mpsc_channel(mpsc_channel &&) = delete;
+    mpsc_channel& operator=(mpsc_channel &&) = delete;
+    ~mpsc_channel() = default;
+#pragma endregion
+
+    /** Create a channel that holds at least capacity messages */
+    explicit mpsc_channel(std::size_t capacity)
+        : mask{ std::bit_ceil(std::max<std::size_t>(capacity, 1u)) - 1u },
+          slots{ std::make_unique<slot[]>(mask + 1u) }
+    {
+        for (std::size_t pos = 0u; pos <= mask; ++pos) {
+            slots[pos].sequence.store(pos, std::memory_order_relaxed);
+        }
+    }
+
+    /** The maximum number of messages the channel can hold at once */
+    std::size_t capacity() const { return mask + 1u; }
+
+    /** Construct a message in the next free slot
+     *
+     * \return false if the channel is full, in which case nothing is sent
+     *
+     * Any number of producers may call this concurrently
+     */
+    template<typename... Args>
+    requires std::constructible_from<Message, Args...>
+    bool try_emplace(Args &&... args)
+    {
+        auto pos = tail.load(std::memory_order_relaxed);
+        slot* claimed = nullptr;
+        while (not claimed) {
+            auto& next = slots[pos & mask];
+            const auto sequence = next.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::intptr_t>(sequence)
+                           - static_cast<std::intptr_t>(pos);
+
+            // the consumer hasn't released this slot yet: the channel is full
+            if (lag < 0) { return false; }
+
+            // another producer claimed the slot first: try again further on
+            if (lag > 0) { pos = tail.load(std::memory_order_relaxed); }
+            else if (tail.compare_exchange_weak(pos, pos + 1u,
+                                                std::memory_order_relaxed)) {
+                claimed = &next;
+            }
+        }
+        claimed->message = Message(std::forward<Args>(args)...);
+        claimed->sequence.store(pos + 1u, std::memory_order_release);
+        return true;
+    }
+    bool try_send(const Message& message) { return try_emplace(message); }
+    bool try_send(Message && message)
+    {
+        return try_emplace(std::move(message));
+    }
+
+    /** Move the oldest message out of the channel
+     *
+     * \param message assigned the received message
+     * \return false if the channel is empty
+     *
+     * Only the consumer may call this
+     */
+    bool try_receive(Message& message)
+    {
+        auto& next = slots[head & mask];
+        if (next.sequence.load(std::memory_order_acquire) != head + 1u) {
+            return false;
+        }
+        message = std::move(next.message);
+        next.sequence.store(head + mask + 1u, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    /** Visit every waiting message in order, consuming them
+     *
+     * \return the number of messages visited
+     */
+    template<std::invocable<Message&> Visitor>
+    std::size_t drain(Visitor visit)
+    {
+        std::size_t count = 0u;
+        for (auto* next = &slots[head & mask];
+                next->sequence.load(std::memory_order_acquire) == head + 1u;
+                next = &slots[head & mask]) {
+
+            std::invoke(visit, next->message);
+            next->sequence.store(head + mask + 1u, std::memory_order_release);
+            ++head; ++count;
+        }
+        return count;
+    }
+private:
+    struct slot {
+        std::atomic<std::size_t> sequence;
+        Message message;
+    };
+    const std::size_t mask;
+    const std::unique_ptr<slot[]> slots;
+
+    // only touched by the consumer
+    alignas(internal::cache_line_size) std::size_t head = 0u;
+
+    // shared by every producer
+    alignas(internal::cache_line_size) std::atomic<std::size_t> tail{ 0u };
+};
+}
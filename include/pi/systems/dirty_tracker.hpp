@@ -0,0 +1,191 @@
+#pragma once
+#include <concepts>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <unordered_map>
+#include <optional>
+#include <vector>
+#include <queue>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <entt/core/fwd.hpp>
+#include "pi/graphs/digraph.hpp"
+#include "pi/systems/system_graph.hpp"
+
+inline namespace pi {
+
+/** How often a system was run or skipped by a dirty tracker */
+struct run_counters {
+    std::uint64_t runs = 0u;
+    std::uint64_t skips = 0u;
+};
+
+/** Run only the systems downstream of a change, in dependency order
+ *
+ * Systems mark their outputs as changed, and the next pass only runs the
+ * systems whose incoming systems have changed. A system that marks its own
+ * outputs as changed while it's run schedules its dependents in the same
+ * pass, so changes propagate as far as they need to and no further. A pass
+ * with no changes does no work.
+ *
+ * Each system runs at most once per pass. Marking a change during a pass
+ * that reaches a system that's already had its turn defers that system to
+ * the next pass.
+ */
+class dirty_tracker {
+public:
+    explicit dirty_tracker(const system_graph& systems) : systems{ &systems }
+    {
+    }
+
+    /** Mark the outputs of a system as changed */
+    void mark_changed(entt::id_type id)
+    {
+        if (current) { schedule_dependents_of(id); }
+        else { changed.push_back(id); }
+    }
+    template<typename System>
+    void mark_changed() { mark_changed(entt::type_hash<System>::value()); }
+
+    /** Run every system downstream of a change, in dependency order
+     *
+     * \param run called with the id of each system that should run
+     * \return the number of systems that were run
+     */
+    template<std::invocable<entt::id_type> Run>
+    std::size_t run_pass(Run run)
+    {
+        namespace ranges = std::ranges;
+
+        // keep up with the graph even when idle, so that systems are
+        // counted as skipped from the first pass they could have run in
+        ++passes;
+        refresh_order();
+        if (changed.empty() and deferred.empty()) { return 0u; }
+
+        ranges::for_each(std::exchange(changed, {}),
+                         [this](entt::id_type id) {
+                             schedule_dependents_of(id);
+                         });
+        ranges::for_each(std::exchange(deferred, {}),
+                         [this](entt::id_type id) { schedule(id); });
+
+        while (not ready.empty()) {
+            current = ready.top();
+            ready.pop();
+            ran.push_back(*current);
+
+            const auto id = order[*current];
+            ++counters.at(id).runs;
+            std::invoke(run, id);
+        }
+        current.reset();
+
+        // only now can the systems that ran be scheduled again
+        for (const auto i : ran) { scheduled[i] = false; }
+        const auto num_runs = ran.size();
+        ran.clear();
+        return num_runs;
+    }
+
+    /** Get how often a system was run or skipped */
+    run_counters counters_of(entt::id_type id) const
+    {
+        const auto search = counters.find(id);
+        if (counters.end() == search) { return run_counters{}; }
+
+        // systems run at most once per pass, so every other pass is a skip
+        const auto& [runs, first_pass] = search->second;
+        const auto num_passes = passes - first_pass;
+        return run_counters{ runs, num_passes - std::min(runs, num_passes) };
+    }
+    template<typename System>
+    run_counters counters_of() const
+    {
+        return counters_of(entt::type_hash<System>::value());
+    }
+private:
+    // rebuild the dependency order whenever the graph has changed
+    void refresh_order()
+    {
+        namespace ranges = std::ranges;
+
+        auto latest = systems->dependencies();
+        if (latest == deps) { return; }
+        deps = std::move(latest);
+
+        order.clear();
+        ranges::copy(graphs::topological_order(*deps),
+                     std::back_inserter(order));
+
+        rank.clear();
+        for (std::size_t i = 0u; i < order.size(); ++i) {
+            rank.emplace(order[i], i);
+
+            // systems new to the graph have only been skipped since now
+            counters.try_emplace(order[i], system_counters{ 0u, passes - 1u });
+        }
+        scheduled.assign(order.size(), false);
+    }
+
+    void schedule_dependents_of(entt::id_type id)
+    {
+        const auto search = deps->find(id);
+        if (deps->end() == search) { return; }
+
+        for (const auto dependent : search->second.outgoing) {
+            const auto dependent_rank = rank.find(dependent);
+            if (rank.end() == dependent_rank) { continue; }
+
+            // systems at or before the one running have had their turn
+            if (not current or dependent_rank->second > *current) {
+                schedule(dependent);
+            }
+            else { deferred.push_back(dependent); }
+        }
+    }
+
+    // schedule a system to run in the current pass, unless it already is
+    void schedule(entt::id_type id)
+    {
+        const auto search = rank.find(id);
+        if (rank.end() == search) { return; }
+
+        const auto i = search->second;
+        if (not scheduled[i]) {
+            scheduled[i] = true;
+            ready.push(i);
+        }
+    }
+
+    struct system_counters {
+        std::uint64_t runs;
+        std::uint64_t first_pass;
+    };
+
+    const system_graph* systems;
+    system_graph::dependency_snapshot deps;
+
+    // systems in dependency order, and each system's place in that order
+    std::vector<entt::id_type> order;
+    std::unordered_map<entt::id_type, std::size_t> rank;
+
+    // scheduled systems, run lowest rank first
+    std::priority_queue<std::size_t, std::vector<std::size_t>,
+                        std::greater<std::size_t>> ready;
+    std::vector<bool> scheduled;
+    std::vector<std::size_t> ran;
+    std::optional<std::size_t> current;
+
+    // changes marked between passes, and systems deferred to the next pass
+    std::vector<entt::id_type> changed;
+    std::vector<entt::id_type> deferred;
+    std::unordered_map<entt::id_type, system_counters> counters;
+    std::uint64_t passes = 0u;
+};
+}
@@ -1,16 +1,23 @@
 #pragma once
 #include <concepts>
+#include <type_traits>
 #include <iterator>
+#include <algorithm>
 
 #include <unordered_map>
 #include <vector>
 #include <deque>
+#include <array>
+#include <span>
 
 #include <memory>
+#include <mutex>
 #include <string_view>
+#include <cstddef>
 
 #include <entt/entity/registry.hpp>
 #include "pi/graphs/digraph.hpp"
+#include "pi/systems/channel.hpp"
 
 #include <cstdio>
 
@@ -22,6 +29,100 @@ constexpr bool has_dependencies = requires(TypeOutput into_types)
     { System::dependencies(into_types) } -> std::same_as<TypeOutput>;
 };
 
+namespace internal {
+template<std::size_t Size>
+constexpr bool all_unique(std::array<entt::id_type, Size> ids)
+{
+    namespace ranges = std::ranges;
+    ranges::sort(ids);
+    return ranges::adjacent_find(ids) == ids.end();
+}
+}
+
+/** Declare the dependencies of a system at compile time
+ *
+ * A system declares its dependencies as a static constexpr member, e.g.
+ * `static constexpr depends_on<first, second> dependencies{};`
+ *
+ * The ids are stored statically, so they can be added to a system graph
+ * without building them at runtime. A depends_on object can still be called
+ * with an output iterator like a dependencies function.
+ */
+template<typename... Systems>
+requires (std::is_class_v<Systems> and ...)
+struct depends_on {
+    static constexpr std::array<entt::id_type, sizeof...(Systems)> ids{
+        entt::type_hash<Systems>::value()...
+    };
+    static_assert(internal::all_unique(ids),
+                  "a system can only depend on another system once");
+
+    template<std::output_iterator<entt::id_type> TypeOutput>
+    constexpr TypeOutput operator()(TypeOutput into_types) const
+    {
+        namespace ranges = std::ranges;
+        return ranges::copy(ids, into_types).out;
+    }
+};
+
+template<typename System>
+constexpr bool has_static_dependencies = requires
+{
+    { System::dependencies.ids }
+        -> std::convertible_to<std::span<const entt::id_type>>;
+};
+
+namespace internal {
+/** A value published to concurrent readers as immutable, shared versions
+ *
+ * Readers hold on to the version they loaded for as long as they need it,
+ * while a writer builds the next version without holding any lock. The lock
+ * only guards swapping which version is the latest, so neither side ever
+ * waits on the other for longer than a pointer copy
+ */
+template<typename Value>
+class published {
+public:
+    published() : latest{ std::make_shared<const Value>() } {}
+
+    published(const published&) = delete;
+    published& operator=(const published&) = delete;
+
+    published(published && tmp) : latest{ tmp.exchange(empty()) } {}
+    published& operator=(published && tmp)
+    {
+        exchange(tmp.exchange(empty()));
+        return *this;
+    }
+
+    /** Get the latest version */
+    std::shared_ptr<const Value> load() const
+    {
+        std::lock_guard lock{ swap_latest };
+        return latest;
+    }
+    /** Replace the latest version with a copy of a value */
+    void publish(const Value& value)
+    {
+        // the old version is released outside of the lock
+        exchange(std::make_shared<const Value>(value));
+    }
+private:
+    using version = std::shared_ptr<const Value>;
+    static version empty() { return std::make_shared<const Value>(); }
+
+    version exchange(version next)
+    {
+        std::lock_guard lock{ swap_latest };
+        latest.swap(next);
+        return next;
+    }
+
+    mutable std::mutex swap_latest;
+    version latest;
+};
+}
+
 class system_graph;
 template<typename System, typename... Args>
 constexpr bool can_load_with =
@@ -37,12 +138,28 @@ public:
     system_graph(const system_graph&) = delete;
     system_graph& operator=(const system_graph&) = delete;
     system_graph(system_graph &&) = default;
-    system_graph& operator=(system_graph &&) = default;
 
-    ~system_graph()
+    system_graph& operator=(system_graph && tmp)
+    {
+        if (this == &tmp) { return *this; }
+
+        // tear down the current systems before their channels are replaced
+        destroy_systems();
+        channels = std::move(tmp.channels);
+        entities = std::move(tmp.entities);
+        deps = std::move(tmp.deps);
+        links = std::move(tmp.links);
+        snapshot = std::move(tmp.snapshot);
+        return *this;
+    }
+
+    ~system_graph() { destroy_systems(); }
+private:
+    // channels are owned separately and outlive every system
+    void destroy_systems()
     {
         graphs::rfor_each(deps, [this](entt::id_type id) {
-            entities.destroy(id);
+            if (entities.valid(id)) { entities.destroy(id); }
         });
     }
 #pragma endregion
@@ -56,8 +173,15 @@ public:
     /** Get the registry used to store systems */
     const auto& registry() const { return entities.ctx(); }
 
-    /** Get a copy of the dependency graph */
-    dependency_map dependencies() const { return deps; }
+    using dependency_snapshot = std::shared_ptr<const dependency_map>;
+
+    /** Get an immutable snapshot of the dependency graph
+     *
+     * Snapshots are shared rather than copied, so getting one is cheap and
+     * safe to do from any thread. A snapshot never changes: systems emplaced
+     * afterwards are only visible in snapshots taken after them
+     */
+    dependency_snapshot dependencies() const { return snapshot.load(); }
 
     /** Emplace a system in the graph using its constructor */
     template<typename System, typename... Args>
@@ -65,6 +189,7 @@ public:
     {
         // register any dependencies the system has declared
         declare_dependencies<System>();
+        snapshot.publish(deps);
 
         // create the entity for this subsystem
         // (destroying any subsystems associated with the type hash)
@@ -106,30 +231,100 @@ public:
         }
         return nullptr;
     }
-private:
-    using id_inserter_t = std::insert_iterator<std::vector<entt::id_type>>;
 
-    template<typename System>
-    void declare_dependencies()
+    /** Connect a producer system to a consumer system with a channel
+     *
+     * \param capacity the minimum number of messages the channel can hold
+     * \return the channel, owned by the system graph
+     *
+     * Channels are recorded in their own edge set rather than as
+     * dependencies, so systems that message each other don't form a cycle
+     * and their load and destroy order is left to their dependencies. Every
+     * channel is destroyed only after every system has been destroyed.
+     * Single-producer channels are unique to each producer and consumer pair,
+     * while multi-producer channels are shared by every producer connected to
+     * the same consumer.
+     *
+     * If the channel already exists, return the existing channel instead
+     */
+    template<typename Producer, typename Consumer, message_channel Channel>
+    Channel& connect(std::size_t capacity)
     {
-        const auto system_id = entt::type_hash<System>::value();
-        graphs::directed_edge_set<entt::id_type> edges;
-        deps.emplace(system_id, edges);
+        graphs::add_edge(links, entt::type_hash<Producer>::value(),
+                                entt::type_hash<Consumer>::value());
+
+        if (auto* channel = find_channel<Producer, Consumer, Channel>()) {
+            return *channel;
+        }
+        using unique_channel = std::unique_ptr<Channel>;
+        const auto entity = channels.create(channel_id<Producer, Consumer,
+                                                       Channel>());
+        auto& channel = channels.emplace<unique_channel>(
+                entity, std::make_unique<Channel>(capacity));
+
+        return *channel;
     }
 
+    /** Get the graph of which systems are connected by channels */
+    const dependency_map& channel_links() const { return links; }
+
+    /** Find the channel connecting a producer to a consumer */
+    template<typename Producer, typename Consumer, message_channel Channel>
+    Channel* find_channel()
+    {
+        using unique_channel = std::unique_ptr<Channel>;
+        const auto id = channel_id<Producer, Consumer, Channel>();
+
+        if (auto* channel = channels.try_get<unique_channel>(id)) {
+            return channel->get();
+        }
+        return nullptr;
+    }
+private:
+    template<typename Producer, typename Consumer, message_channel Channel>
+    static constexpr entt::id_type channel_id()
+    {
+        // multi-producer channels are shared, so they're keyed by consumer
+        entt::id_type id = entt::type_hash<Channel>::value();
+        const auto combine = [&id](entt::id_type with) {
+            id ^= with + 0x9e3779b9u + (id << 6) + (id >> 2);
+        };
+        combine(entt::type_hash<Consumer>::value());
+        if constexpr (Channel::single_producer) {
+            combine(entt::type_hash<Producer>::value());
+        }
+        return id;
+    }
+
+    using id_inserter_t = std::insert_iterator<std::vector<entt::id_type>>;
+
     template<typename System>
-    requires has_dependencies<System, id_inserter_t>
     void declare_dependencies()
     {
-        std::vector<entt::id_type> incoming;
-        System::dependencies(std::back_inserter(incoming));
-
         const auto to = entt::type_hash<System>::value();
-        graphs::add_edges_from(deps, incoming, to);
+        if constexpr (has_static_dependencies<System>) {
+            // add edges straight from the statically stored ids
+            const std::span<const entt::id_type> incoming =
+                System::dependencies.ids;
+            graphs::add_edges_from(deps, incoming, to);
+        }
+        else if constexpr (has_dependencies<System, id_inserter_t>) {
+            std::vector<entt::id_type> incoming;
+            System::dependencies(std::back_inserter(incoming));
+            graphs::add_edges_from(deps, incoming, to);
+        }
+        else {
+            graphs::directed_edge_set<entt::id_type> edges;
+            deps.emplace(to, edges);
+        }
     }
 
+    // declared first so channels are released after every system
+    entt::basic_registry<entt::id_type> channels;
     entt::basic_registry<entt::id_type> entities;
     dependency_map deps;
+    dependency_map links;
+    internal::published<dependency_map> snapshot;
 #pragma endregion
 };
 }